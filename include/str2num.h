@@ -12,6 +12,9 @@
 
 #include <cwchar>
 #include <cwctype>
+
+#include "str2num_tables.h"
+
 #if (defined(__GNUC__) || defined(__clang__))
 #define s2n_likely(x) __builtin_expect(!!(x), 1)
 #define s2n_unlikely(x) __builtin_expect(!!(x), 0)
@@ -22,6 +25,55 @@
 
 typedef enum { STR2NUM_SUCCESS, STR2NUM_OVERFLOW, STR2NUM_UNDERFLOW, STR2NUM_INCONVERTIBLE } str2num_errno;
 
+namespace s2n {
+namespace detail {
+/*
+ * Fast path for plain base 10 input: an optional sign followed by digits.
+ * Returns false, without touching out, endptr or errno, for anything else so
+ * the caller can fall back to libc.
+ *
+ * Mirrors what the strto* call returning L would report for the same input,
+ * errno included: it consumes every digit, overflowing or not, and sets
+ * ERANGE when the magnitude does not fit L. Negative input to unsigned types
+ * is left to libc, which wraps it around.
+ */
+template <typename T, typename L>
+inline bool parse_decimal(str2num_errno *err, T *out, const char *s, char **endptr) {
+    const char *p = s;
+    bool negative = (*p == '-');
+    if (*p == '-' || *p == '+') ++p;
+    if (std::is_unsigned<T>::value && negative) return false;
+    const char *digits = p;
+    const unsigned long long cutoff = tables.cutoff_u64[10];
+    const uint8_t cutlim = tables.cutlim_u64[10];
+    unsigned long long magnitude = 0;
+    bool out_of_range = false;
+    for (uint8_t d; (d = tables.digit_value[(unsigned char)*p]) < 10; ++p) {
+        if (s2n_unlikely(magnitude > cutoff || (magnitude == cutoff && d > cutlim)))
+            out_of_range = true;
+        else
+            magnitude = magnitude * 10 + d;
+    }
+    if (s2n_unlikely(p == digits)) return false;
+    if (endptr != nullptr) *endptr = const_cast<char *>(p);
+    if (s2n_unlikely(out_of_range || (!negative && magnitude > int_limits<L>::max_positive) ||
+                     (negative && magnitude > int_limits<L>::max_negative)))
+        errno = ERANGE;
+    if (s2n_unlikely(!negative && (out_of_range || magnitude > int_limits<T>::max_positive)))
+        *err = STR2NUM_OVERFLOW;
+    else if (s2n_unlikely(negative && (out_of_range || magnitude > int_limits<T>::max_negative)))
+        *err = STR2NUM_UNDERFLOW;
+    else if (s2n_unlikely(endptr != nullptr && **endptr != '\0'))
+        *err = STR2NUM_INCONVERTIBLE;
+    else {
+        *out = negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+        *err = STR2NUM_SUCCESS;
+    }
+    return true;
+}
+};  // namespace detail
+};  // namespace s2n
+
 /*
  * Convert a string to an integer.
  *
@@ -38,6 +90,8 @@ typedef enum { STR2NUM_SUCCESS, STR2NUM_OVERFLOW, STR2NUM_UNDERFLOW, STR2NUM_INC
 str2num_errno str2int(int *out, const char *s, char **endptr, int base) {
     if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
     errno = 0;
+    str2num_errno err;
+    if (base == 10 && s2n::detail::parse_decimal<int, long>(&err, out, s, endptr)) return err;
     long l = strtol(s, endptr, base);
     /* Both checks are needed because INT_MAX == LONG_MAX is possible. */
     if (s2n_unlikely(l > INT_MAX || (errno == ERANGE && l == LONG_MAX))) return STR2NUM_OVERFLOW;
@@ -120,6 +174,8 @@ str2num_errno str2uint(unsigned int *out, const wchar_t *s) { return str2uint(ou
 str2num_errno str2l(long *out, const char *s, char **endptr, int base) {
     if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
     errno = 0;
+    str2num_errno err;
+    if (base == 10 && s2n::detail::parse_decimal<long, long>(&err, out, s, endptr)) return err;
     long l = strtol(s, endptr, base);
     if (s2n_unlikely(errno == ERANGE && l == LONG_MAX)) return STR2NUM_OVERFLOW;
     if (s2n_unlikely(errno == ERANGE && l == LONG_MIN)) return STR2NUM_UNDERFLOW;
@@ -197,6 +253,8 @@ str2num_errno str2ul(unsigned long *out, const wchar_t *s) { return str2ul(out,
 str2num_errno str2ll(long long int *out, const char *s, char **endptr, int base) {
     if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
     errno = 0;
+    str2num_errno err;
+    if (base == 10 && s2n::detail::parse_decimal<long long int, long long int>(&err, out, s, endptr)) return err;
     long long int l = strtoll(s, endptr, base);
     /* Both checks are needed because l == LONG_MAX or l == LLONG_MIN is possible. */
     if (s2n_unlikely(errno == ERANGE && l == LLONG_MAX)) return STR2NUM_OVERFLOW;
@@ -237,6 +295,10 @@ str2num_errno str2ll(long long int *out, const wchar_t *s) { return str2ll(out,
 str2num_errno str2ull(long long unsigned int *out, const char *s, char **endptr = nullptr, int base = 10) {
     if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
     errno = 0;
+    str2num_errno err;
+    if (base == 10 &&
+        s2n::detail::parse_decimal<long long unsigned int, long long unsigned int>(&err, out, s, endptr))
+        return err;
     long long unsigned int l = strtoull(s, endptr, base);
     /* Both checks are needed because INT_MAX == LONG_MAX is possible. */
     if (s2n_unlikely(errno == ERANGE && l == ULLONG_MAX)) return STR2NUM_OVERFLOW;
@@ -0,0 +1,461 @@
+//  SPDX-FileCopyrightText: 2022 Kish Jadhav
+//  SPDX-License-Identifier: MIT License
+
+#ifndef STR2NUM_PIPELINE_H
+#define STR2NUM_PIPELINE_H
+
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "str2num.h"
+
+/*
+ * Pipelined bulk conversion for ingest threads.
+ *
+ * Producers submit raw buffers of delimited numbers, a pool of workers
+ * converts them with parse_column and the resulting typed columns come back
+ * in submission order, through the returned futures and an optional callback.
+ * The hand-off between producers and workers is a lock-free bounded queue.
+ * submit blocks while the queue is full or too many buffers are undelivered,
+ * which bounds the memory of the whole pipeline and is the backpressure on the
+ * producers.
+ *
+ * Example:
+ *   s2n::conversion_pipeline<long long> pipeline;
+ *   auto chunk = pipeline.submit("1\n2\n3\n");
+ *   std::vector<long long> values = chunk.get().values;
+ */
+namespace s2n {
+/*
+ * A column of converted values.
+ *
+ * errors has one entry per value. Values whose entry is not STR2NUM_SUCCESS
+ * are left value initialized (0).
+ */
+template <typename T>
+struct column {
+    std::vector<T> values;
+    std::vector<str2num_errno> errors;
+    std::size_t invalid = 0;
+};
+
+namespace detail {
+inline str2num_errno str2num(int *out, const char *s, char **endptr) { return str2int(out, s, endptr, 10); }
+inline str2num_errno str2num(unsigned int *out, const char *s, char **endptr) { return str2uint(out, s, endptr, 10); }
+inline str2num_errno str2num(long *out, const char *s, char **endptr) { return str2l(out, s, endptr, 10); }
+inline str2num_errno str2num(unsigned long *out, const char *s, char **endptr) { return str2ul(out, s, endptr, 10); }
+inline str2num_errno str2num(long long *out, const char *s, char **endptr) { return str2ll(out, s, endptr, 10); }
+inline str2num_errno str2num(unsigned long long *out, const char *s, char **endptr) {
+    return str2ull(out, s, endptr, 10);
+}
+inline str2num_errno str2num(float *out, const char *s, char **endptr) { return str2f(out, s, endptr); }
+inline str2num_errno str2num(double *out, const char *s, char **endptr) { return str2d(out, s, endptr); }
+};  // namespace detail
+
+/*
+ * Convert every delimited field of buffer.
+ *
+ * A delimiter at the very end of the buffer does not start another field. A
+ * field with anything after the number is STR2NUM_INCONVERTIBLE, for the
+ * floating point types as well.
+ *
+ * @param buffer The raw fields, consumed to terminate them in place.
+ * @param delimiter The field separator.
+ *
+ * @return The converted column.
+ */
+template <typename T>
+column<T> parse_column(std::string buffer, char delimiter = '\n') {
+    column<T> out;
+    char *p = &buffer[0];
+    char *const last = p + buffer.size();
+    while (p < last) {
+        char *field_end = static_cast<char *>(memchr(p, delimiter, last - p));
+        if (field_end == nullptr) field_end = last;
+        *field_end = '\0';
+        T value{};
+        char *endptr = nullptr;
+        str2num_errno err = detail::str2num(&value, p, &endptr);
+        if (err == STR2NUM_SUCCESS && *endptr != '\0') err = STR2NUM_INCONVERTIBLE;
+        if (err != STR2NUM_SUCCESS) {
+            value = T{};
+            ++out.invalid;
+        }
+        out.values.push_back(value);
+        out.errors.push_back(err);
+        p = field_end + 1;
+    }
+    return out;
+}
+
+/*
+ * Lock-free bounded multi-producer multi-consumer queue.
+ *
+ * Each cell carries a sequence number telling producers and consumers whose
+ * turn it is, so head and tail are only ever advanced with a compare and swap.
+ * The capacity is rounded up to a power of two.
+ */
+template <typename T>
+class bounded_queue {
+   public:
+    explicit bounded_queue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask_ = size - 1;
+        cells_.reset(new cell[size]);
+        for (std::size_t i = 0; i < size; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+    }
+    bounded_queue(const bounded_queue &) = delete;
+    bounded_queue &operator=(const bounded_queue &) = delete;
+
+    /* @return false, leaving value untouched, if the queue is full. */
+    bool try_push(T &value) noexcept {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell &c = cells_[pos & mask_];
+            std::size_t seq = c.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = std::move(value);
+                    c.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /* @return false if the queue is empty. */
+    bool try_pop(T &value) noexcept {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell &c = cells_[pos & mask_];
+            std::size_t seq = c.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(c.value);
+                    c.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+    /*
+     * Number of claimed cells, never more than capacity(). Only a snapshot
+     * while other threads push or pop.
+     */
+    std::size_t size() const noexcept {
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        std::size_t head = head_.load(std::memory_order_acquire);
+        if (head >= tail) return 0;
+        return tail - head < capacity() ? tail - head : capacity();
+    }
+
+   private:
+    struct cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+    std::unique_ptr<cell[]> cells_;
+    std::size_t mask_;
+    /* head and tail on their own cache lines, producers and consumers do not share. */
+    alignas(64) std::atomic<std::size_t> head_;
+    alignas(64) std::atomic<std::size_t> tail_;
+};
+
+struct pipeline_options {
+    /* Number of parse workers, 0 for one per hardware thread. */
+    std::size_t workers = 0;
+    /* Buffers that may wait for a worker before submit blocks. */
+    std::size_t queue_capacity = 64;
+    /*
+     * Buffers submitted but not yet delivered, queued, being parsed or parked
+     * behind an earlier buffer, before submit blocks. 0 for the queue capacity
+     * plus one per worker.
+     */
+    std::size_t max_in_flight = 0;
+    char delimiter = '\n';
+};
+
+struct pipeline_stats {
+    std::uint64_t submitted = 0;
+    std::uint64_t completed = 0;
+    std::uint64_t values = 0;
+    std::uint64_t invalid = 0;
+    std::uint64_t bytes = 0;
+    /* Buffers waiting in the queue right now and the most there ever were. */
+    std::size_t queue_depth = 0;
+    std::size_t max_queue_depth = 0;
+    /* Buffers submitted but not yet delivered. */
+    std::size_t in_flight = 0;
+    /* Time since the first submit; the rates are averages over it. */
+    double seconds = 0;
+    double values_per_second = 0;
+    double bytes_per_second = 0;
+};
+
+/*
+ * Bulk conversion of submitted buffers into columns of T on a worker pool.
+ *
+ * on_chunk, if set, is called with each column in submission order, from a
+ * worker thread, before the matching future becomes ready. Only one worker
+ * delivers at a time and it does so without holding any lock, so a slow
+ * callback delays delivery but not parsing. It must not throw and must not
+ * call submit on the same pipeline: its chunk still holds an in-flight slot
+ * and only the delivering worker can free one, so a full window deadlocks.
+ *
+ * submit may be called from several producer threads; submission order is
+ * then the order in which the calls got their sequence number. The destructor
+ * finishes all submitted work before joining the workers.
+ */
+template <typename T>
+class conversion_pipeline {
+   public:
+    using chunk_callback = std::function<void(std::uint64_t sequence, const column<T> &chunk)>;
+
+    explicit conversion_pipeline(const pipeline_options &options = pipeline_options(),
+                                 chunk_callback on_chunk = nullptr)
+        : options_(options), on_chunk_(std::move(on_chunk)), queue_(options.queue_capacity) {
+        std::size_t workers = options_.workers;
+        if (workers == 0) workers = std::thread::hardware_concurrency();
+        if (workers == 0) workers = 1;
+        max_in_flight_ = options_.max_in_flight != 0 ? options_.max_in_flight : queue_.capacity() + workers;
+        for (std::size_t i = 0; i < workers; ++i) workers_.emplace_back(&conversion_pipeline::work, this);
+    }
+    conversion_pipeline(const conversion_pipeline &) = delete;
+    conversion_pipeline &operator=(const conversion_pipeline &) = delete;
+
+    ~conversion_pipeline() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        not_empty_.notify_all();
+        for (std::thread &worker : workers_) worker.join();
+    }
+
+    /*
+     * Queue buffer for conversion, blocking while max_in_flight buffers are
+     * undelivered or the queue is full.
+     *
+     * @param buffer Raw delimited fields.
+     *
+     * @return The converted column, ready once all earlier buffers are.
+     */
+    std::future<column<T>> submit(std::string buffer) {
+        std::call_once(started_, [this] { start_ = std::chrono::steady_clock::now(); });
+        reserve_slot();
+        job j;
+        j.sequence = next_sequence_.fetch_add(1);
+        j.buffer = std::move(buffer);
+        j.promise = std::make_unique<std::promise<column<T>>>();
+        std::future<column<T>> result = j.promise->get_future();
+        bytes_.fetch_add(j.buffer.size(), std::memory_order_relaxed);
+        while (!queue_.try_push(j)) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ++waiting_producers_;
+            not_full_.wait(lock, [this] { return pending() < queue_.capacity(); });
+            --waiting_producers_;
+        }
+        pushed_.fetch_add(1);
+        std::size_t depth = queue_.size();
+        std::size_t max_depth = max_queue_depth_.load(std::memory_order_relaxed);
+        while (depth > max_depth && !max_queue_depth_.compare_exchange_weak(max_depth, depth)) {
+        }
+        if (waiting_workers_.load() > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        not_empty_.notify_one();
+        return result;
+    }
+
+    /* A snapshot of the counters, consistent per field only. */
+    pipeline_stats stats() const {
+        pipeline_stats s;
+        s.submitted = pushed_.load();
+        s.completed = completed_.load();
+        s.values = values_.load();
+        s.invalid = invalid_.load();
+        s.bytes = bytes_.load();
+        s.queue_depth = queue_.size();
+        s.max_queue_depth = max_queue_depth_.load();
+        s.in_flight = in_flight_.load();
+        if (s.submitted > 0) {
+            s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        }
+        if (s.seconds > 0) {
+            s.values_per_second = s.values / s.seconds;
+            s.bytes_per_second = s.bytes / s.seconds;
+        }
+        return s;
+    }
+
+    std::size_t workers() const noexcept { return workers_.size(); }
+    std::size_t queue_capacity() const noexcept { return queue_.capacity(); }
+    std::size_t max_in_flight() const noexcept { return max_in_flight_; }
+
+   private:
+    /*
+     * The promise is held by pointer: a default constructed std::promise
+     * allocates its shared state, and every queue cell holds a job.
+     */
+    struct job {
+        std::uint64_t sequence = 0;
+        std::string buffer;
+        std::unique_ptr<std::promise<column<T>>> promise;
+    };
+    struct delivery {
+        std::uint64_t sequence;
+        std::unique_ptr<std::promise<column<T>>> promise;
+        column<T> chunk;
+    };
+
+    /*
+     * Pushed but not yet popped buffers. Lags the queue itself, it only
+     * decides when idle workers and blocked producers sleep.
+     */
+    std::size_t pending() const noexcept {
+        std::uint64_t pushed = pushed_.load(), popped = popped_.load();
+        return pushed > popped ? (std::size_t)(pushed - popped) : 0;
+    }
+
+    /* Take one of the max_in_flight slots, waiting for a delivery if there is none. */
+    void reserve_slot() {
+        std::size_t in_flight = in_flight_.load();
+        for (;;) {
+            if (in_flight < max_in_flight_) {
+                if (in_flight_.compare_exchange_weak(in_flight, in_flight + 1)) return;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            ++waiting_for_slot_;
+            window_open_.wait(lock, [this] { return in_flight_.load() < max_in_flight_; });
+            --waiting_for_slot_;
+            in_flight = in_flight_.load();
+        }
+    }
+
+    void work() {
+        job j;
+        for (;;) {
+            if (queue_.try_pop(j)) {
+                popped_.fetch_add(1);
+                if (waiting_producers_.load() > 0) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                }
+                not_full_.notify_one();
+                column<T> chunk = parse_column<T>(std::move(j.buffer), options_.delimiter);
+                deliver(delivery{j.sequence, std::move(j.promise), std::move(chunk)});
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            ++waiting_workers_;
+            not_empty_.wait(lock, [this] { return stopping_ || pending() > 0; });
+            --waiting_workers_;
+            if (stopping_ && pending() == 0) return;
+        }
+    }
+
+    /*
+     * Park the finished chunk. If no other worker is delivering, become the
+     * deliverer: take the run of chunks that is now in order under the lock,
+     * hand it out without the lock and repeat until nothing is in order.
+     */
+    void deliver(delivery &&finished) {
+        std::vector<delivery> run;
+        std::unique_lock<std::mutex> lock(deliver_mutex_);
+        ready_.emplace(finished.sequence, std::move(finished));
+        if (delivering_) return;
+        delivering_ = true;
+        for (;;) {
+            for (auto it = ready_.begin(); it != ready_.end() && it->first == next_delivery_; it = ready_.begin()) {
+                run.push_back(std::move(it->second));
+                ready_.erase(it);
+                ++next_delivery_;
+            }
+            if (run.empty()) {
+                delivering_ = false;
+                return;
+            }
+            lock.unlock();
+            for (delivery &d : run) {
+                values_.fetch_add(d.chunk.values.size(), std::memory_order_relaxed);
+                invalid_.fetch_add(d.chunk.invalid, std::memory_order_relaxed);
+                if (on_chunk_) on_chunk_(d.sequence, d.chunk);
+                /* Counted before the future is ready, so stats() agree with it. */
+                completed_.fetch_add(1);
+                in_flight_.fetch_sub(1);
+                d.promise->set_value(std::move(d.chunk));
+            }
+            if (waiting_for_slot_.load() > 0) {
+                std::lock_guard<std::mutex> slot_lock(mutex_);
+            }
+            window_open_.notify_all();
+            run.clear();
+            lock.lock();
+        }
+    }
+
+    const pipeline_options options_;
+    const chunk_callback on_chunk_;
+    bounded_queue<job> queue_;
+    std::vector<std::thread> workers_;
+    std::size_t max_in_flight_ = 0;
+    std::once_flag started_;
+    std::chrono::steady_clock::time_point start_;
+
+    /* Only used to park idle workers and blocked producers. */
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::condition_variable window_open_;
+    bool stopping_ = false;
+    std::atomic<std::size_t> waiting_workers_{0};
+    std::atomic<std::size_t> waiting_producers_{0};
+    std::atomic<std::size_t> waiting_for_slot_{0};
+
+    std::mutex deliver_mutex_;
+    std::map<std::uint64_t, delivery> ready_;
+    std::uint64_t next_delivery_ = 0;
+    bool delivering_ = false;
+
+    std::atomic<std::uint64_t> next_sequence_{0};
+    std::atomic<std::size_t> in_flight_{0};
+    std::atomic<std::uint64_t> pushed_{0};
+    std::atomic<std::uint64_t> popped_{0};
+    std::atomic<std::uint64_t> completed_{0};
+    std::atomic<std::uint64_t> values_{0};
+    std::atomic<std::uint64_t> invalid_{0};
+    std::atomic<std::uint64_t> bytes_{0};
+    std::atomic<std::size_t> max_queue_depth_{0};
+};
+};  // namespace s2n
+
+#endif
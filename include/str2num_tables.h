@@ -0,0 +1,149 @@
+//  SPDX-FileCopyrightText: 2022 Kish Jadhav
+//  SPDX-License-Identifier: MIT License
+
+#ifndef STR2NUM_TABLES_H
+#define STR2NUM_TABLES_H
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <limits>
+#include <type_traits>
+
+/*
+ * Lookup tables shared by every str2* engine.
+ *
+ * All tables live in one constexpr generated, cache line aligned object so a
+ * row mixing ints and doubles touches a single contiguous block instead of one
+ * table set per parser. The hot tables come first.
+ *
+ * Memory footprint (checked by the static_assert below):
+ *   digit_value       256 B   character -> digit value, 0xff if not a digit
+ *   pow10_u64         160 B   10^0 .. 10^19
+ *   pow10_f64         184 B   10^0 .. 10^22, exactly representable doubles
+ *   cutoff_u64        296 B   ULLONG_MAX / base, for base 0 .. 36
+ *   cutlim_u64         37 B   ULLONG_MAX % base
+ *   pow5_128         1328 B   5^q for q in [-27, 55] as normalized 128 bits
+ *                   ------
+ *                   ~2.3 KB, well inside a 32 KB L1 data cache.
+ *
+ * The integer fast path reads digit_value and the base 10 cutoffs. pow10_u64,
+ * pow10_f64 and pow5_128 are staged for the floating point kernels, which do
+ * not exist yet; str2f and str2d still go to libc. pow5_128 covers the decimal
+ * exponents where a 64-bit mantissa times 5^q is exact or needs a single
+ * 128-bit product.
+ */
+namespace s2n {
+namespace detail {
+struct uint128 {
+    uint64_t hi;
+    uint64_t lo;
+};
+
+struct alignas(64) tables_t {
+    static constexpr int pow5_min = -27;
+    static constexpr int pow5_max = 55;
+    static constexpr int max_base = 36;
+
+    uint8_t digit_value[256];
+    uint64_t pow10_u64[20];
+    double pow10_f64[23];
+    uint64_t cutoff_u64[max_base + 1];
+    uint8_t cutlim_u64[max_base + 1];
+    uint128 pow5_128[pow5_max - pow5_min + 1];
+
+    /* 5^q normalized so that the top bit of hi is set, rounded up for q < 0. */
+    constexpr const uint128 &pow5(int q) const { return pow5_128[q - pow5_min]; }
+};
+
+/* (hi, lo) * 5, dropping anything above 128 bits. */
+constexpr uint128 mul5(uint128 v) {
+    uint64_t a = (v.lo & 0xffffffffu) * 5;
+    uint64_t b = (v.lo >> 32) * 5 + (a >> 32);
+    return uint128{v.hi * 5 + (b >> 32), (b << 32) | (a & 0xffffffffu)};
+}
+
+constexpr uint128 normalize(uint128 v) {
+    while ((v.hi >> 63) == 0) {
+        v.hi = (v.hi << 1) | (v.lo >> 63);
+        v.lo <<= 1;
+    }
+    return v;
+}
+
+/*
+ * floor(2^(z + 127) / 5^n) + 1 where 5^n needs z bits, i.e. 5^-n rounded up to
+ * 128 significant bits. Binary long division, 5^n < 2^63 keeps the remainder
+ * from overflowing.
+ */
+constexpr uint128 reciprocal_pow5(int n) {
+    uint64_t d = 1;
+    for (int i = 0; i < n; ++i) d *= 5;
+    int z = 0;
+    while (z < 64 && (uint64_t(1) << z) < d) ++z;
+    uint128 q{0, 0};
+    uint64_t r = 0;
+    for (int bit = 0; bit < z + 128; ++bit) {
+        r = (r << 1) | (bit == 0 ? 1 : 0);
+        q.hi = (q.hi << 1) | (q.lo >> 63);
+        q.lo <<= 1;
+        if (r >= d) {
+            r -= d;
+            q.lo |= 1;
+        }
+    }
+    if (++q.lo == 0) ++q.hi;
+    if (q.hi == 0 && q.lo == 0) q = uint128{uint64_t(1) << 63, 0};
+    return normalize(q);
+}
+
+constexpr tables_t make_tables() {
+    tables_t t{};
+    for (int c = 0; c < 256; ++c) {
+        if (c >= '0' && c <= '9')
+            t.digit_value[c] = uint8_t(c - '0');
+        else if (c >= 'a' && c <= 'z')
+            t.digit_value[c] = uint8_t(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'Z')
+            t.digit_value[c] = uint8_t(c - 'A' + 10);
+        else
+            t.digit_value[c] = 0xff;
+    }
+    t.pow10_u64[0] = 1;
+    for (int i = 1; i < 20; ++i) t.pow10_u64[i] = t.pow10_u64[i - 1] * 10;
+    t.pow10_f64[0] = 1.0;
+    for (int i = 1; i < 23; ++i) t.pow10_f64[i] = t.pow10_f64[i - 1] * 10.0;
+    for (int base = 2; base <= tables_t::max_base; ++base) {
+        t.cutoff_u64[base] = ULLONG_MAX / base;
+        t.cutlim_u64[base] = uint8_t(ULLONG_MAX % base);
+    }
+    uint128 p{0, 1};
+    for (int q = 0; q <= tables_t::pow5_max; ++q) {
+        t.pow5_128[q - tables_t::pow5_min] = normalize(p);
+        p = mul5(p);
+    }
+    for (int q = tables_t::pow5_min; q < 0; ++q) t.pow5_128[q - tables_t::pow5_min] = reciprocal_pow5(-q);
+    return t;
+}
+
+inline constexpr tables_t tables = make_tables();
+
+static_assert(sizeof(tables_t) <= 2560, "str2num tables no longer fit their documented footprint");
+static_assert(tables.pow10_f64[22] == 1e22, "10^22 must be exact");
+
+/*
+ * Per-type overflow thresholds as magnitudes: the largest positive value and
+ * the largest negative value (0 for unsigned types) that fit in T.
+ */
+template <typename T>
+struct int_limits {
+    static_assert(std::is_integral<T>::value, "int_limits needs an integer type");
+    static constexpr unsigned long long max_positive = (unsigned long long)std::numeric_limits<T>::max();
+    static constexpr unsigned long long max_negative =
+        std::is_signed<T>::value ? max_positive + 1 : 0;
+};
+};  // namespace detail
+};  // namespace s2n
+
+#endif
@@ -0,0 +1,66 @@
+//  SPDX-FileCopyrightText: 2022 Kish Jadhav
+//  SPDX-License-Identifier: MIT License
+#include "str2num.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Time the str2* integer conversions against calling libc directly, on 1M
+ * random base 10 integers of every length. Not run by ctest, build it in
+ * Release and run str2num_bench by hand.
+ */
+static std::vector<std::string> make_inputs(bool with_sign){
+    std::mt19937_64 rng(2022);
+    std::vector<std::string> inputs;
+    for(int i = 0; i < 1000000; ++i){
+        unsigned long long value = rng() >> (rng() % 64);
+        if(with_sign) inputs.push_back(std::to_string((long long)value * ((rng() & 1) ? -1 : 1)));
+        else inputs.push_back(std::to_string(value));
+    }
+    return inputs;
+}
+
+template <typename Fn>
+static void bench(const char *name, const std::vector<std::string> &inputs, Fn fn){
+    auto start = std::chrono::steady_clock::now();
+    unsigned long long sum = 0;
+    for(const auto &input : inputs) sum += fn(input.c_str());
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << ns / inputs.size() << " ns/op (checksum " << sum << ")\n";
+}
+
+int main(){
+    std::vector<std::string> signed_inputs = make_inputs(true);
+    std::vector<std::string> unsigned_inputs = make_inputs(false);
+    bench("strtoll ", signed_inputs, [](const char *s){
+        errno = 0;
+        return (unsigned long long)strtoll(s, nullptr, 10);
+    });
+    bench("str2ll  ", signed_inputs, [](const char *s){
+        long long v = 0;
+        str2ll(&v, s, nullptr, 10);
+        return (unsigned long long)v;
+    });
+    bench("strtoull", unsigned_inputs, [](const char *s){
+        errno = 0;
+        return strtoull(s, nullptr, 10);
+    });
+    bench("str2ull ", unsigned_inputs, [](const char *s){
+        unsigned long long v = 0;
+        str2ull(&v, s, nullptr, 10);
+        return v;
+    });
+    bench("strtol  ", signed_inputs, [](const char *s){
+        errno = 0;
+        return (unsigned long long)strtol(s, nullptr, 10);
+    });
+    bench("str2int ", signed_inputs, [](const char *s){
+        int v = 0;
+        str2int(&v, s, nullptr, 10);
+        return (unsigned long long)v;
+    });
+    return 0;
+}
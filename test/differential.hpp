@@ -0,0 +1,253 @@
+//  SPDX-FileCopyrightText: 2022 Kish Jadhav
+//  SPDX-License-Identifier: MIT License
+#ifndef DIFFERENTIAL_HPP
+#define DIFFERENTIAL_HPP
+#include <string.h>
+
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "reference_str2num.hpp"
+
+/*
+ * Differential checks of the str2* functions against the frozen libc
+ * reference in reference_str2num.hpp.
+ *
+ * Every check runs the conversion twice, with and without endptr, and
+ * compares the returned error code, the bits written to out, the value
+ * stored in endptr and errno. out, endptr and errno start from a sentinel so
+ * that "left untouched" is compared as well. Each input is also widened and run through
+ * the wchar_t overloads, and through the s2n::safe_sto* wrappers.
+ */
+namespace s2n_diff {
+static unsigned long long checks = 0;
+static unsigned long long mismatches = 0;
+static const unsigned long long max_reported = 20;
+/* Not a real errno value, so a conversion that leaves errno alone shows up. */
+static const int errno_sentinel = -12345;
+
+template <typename CharT>
+static CharT *sentinel() {
+    static CharT sentinel_char;
+    return &sentinel_char;
+}
+
+static const char *errno_name(str2num_errno err) {
+    switch (err) {
+        case STR2NUM_SUCCESS: return "SUCCESS";
+        case STR2NUM_OVERFLOW: return "OVERFLOW";
+        case STR2NUM_UNDERFLOW: return "UNDERFLOW";
+        case STR2NUM_INCONVERTIBLE: return "INCONVERTIBLE";
+    }
+    return "?";
+}
+
+static std::string escape(const char *s) {
+    if (s == nullptr) return "(null)";
+    std::string out;
+    for (; *s != '\0'; ++s) {
+        unsigned char c = *s;
+        if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\') {
+            out += c;
+        } else {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\x%02x", c);
+            out += buf;
+        }
+    }
+    return out;
+}
+
+/* Byte for byte widening, so wide and narrow inputs hold the same code points. */
+static std::wstring widen(const char *s) {
+    std::wstring out;
+    for (; *s != '\0'; ++s) out += (wchar_t)(unsigned char)*s;
+    return out;
+}
+
+template <typename T>
+static std::string hex_bits(const T &value) {
+    std::string out = "0x";
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&value);
+    for (size_t i = sizeof(T); i-- > 0;) {
+        char buf[4];
+        snprintf(buf, sizeof(buf), "%02x", bytes[i]);
+        out += buf;
+    }
+    return out;
+}
+
+template <typename CharT>
+static std::string end_offset(const CharT *s, const CharT *end) {
+    if (end == sentinel<CharT>()) return "untouched";
+    if (end == nullptr) return "null";
+    return std::to_string(end - s);
+}
+
+static void report(const char *name, const char *s, int base, const char *mode, const std::string &result,
+                   const std::string &ref_result) {
+    if (mismatches++ < max_reported) {
+        std::cerr << "MISMATCH " << name << "(\"" << escape(s) << "\", base " << base << ", " << mode << ")\n"
+                  << "    str2num:   " << result << "\n"
+                  << "    reference: " << ref_result << "\n";
+    }
+}
+
+/*
+ * s is the narrow input for the report, input what the conversion was given.
+ */
+template <typename T, typename CharT>
+static bool compare(const char *name, const char *s, const CharT *input, int base, bool with_end,
+                    str2num_errno err, const T &out, const CharT *end, int error, str2num_errno ref_err,
+                    const T &ref_out, const CharT *ref_end, int ref_error) {
+    ++checks;
+    if (err == ref_err && memcmp(&out, &ref_out, sizeof(T)) == 0 && end == ref_end && error == ref_error) return true;
+    const char *mode = sizeof(CharT) == 1 ? (with_end ? "endptr" : "no endptr")
+                                          : (with_end ? "wide, endptr" : "wide, no endptr");
+    report(name, s, base, mode,
+           std::string(errno_name(err)) + " out=" + hex_bits(out) + " end=" + end_offset(input, end) +
+               " errno=" + std::to_string(error),
+           std::string(errno_name(ref_err)) + " out=" + hex_bits(ref_out) + " end=" + end_offset(input, ref_end) +
+               " errno=" + std::to_string(ref_error));
+    return false;
+}
+
+/*
+ * strtol leaves endptr indeterminate for a base outside 0 and 2..36; glibc does
+ * not touch it but the ASan interceptor does, and str2* then dereferences it.
+ * Such bases are only checked without endptr.
+ */
+static bool valid_base(int base) { return base == 0 || (base >= 2 && base <= 36); }
+
+template <typename T, typename CharT>
+static bool check_integer(const char *name, str2num_errno (*fn)(T *, const CharT *, CharT **, int),
+                          str2num_errno (*ref)(T *, const CharT *, CharT **, int), const char *s,
+                          const CharT *input, int base) {
+    bool ok = true;
+    for (int with_end = 0; with_end < (valid_base(base) ? 2 : 1); ++with_end) {
+        T out, ref_out;
+        memset(&out, 0xa5, sizeof(T));
+        memset(&ref_out, 0xa5, sizeof(T));
+        CharT *end = sentinel<CharT>(), *ref_end = sentinel<CharT>();
+        errno = errno_sentinel;
+        str2num_errno err = fn(&out, input, with_end ? &end : nullptr, base);
+        int error = errno;
+        errno = errno_sentinel;
+        str2num_errno ref_err = ref(&ref_out, input, with_end ? &ref_end : nullptr, base);
+        int ref_error = errno;
+        ok &= compare(name, s, input, base, with_end, err, out, end, error, ref_err, ref_out, ref_end, ref_error);
+    }
+    return ok;
+}
+
+template <typename T, typename CharT>
+static bool check_floating(const char *name, str2num_errno (*fn)(T *, const CharT *, CharT **),
+                           str2num_errno (*ref)(T *, const CharT *, CharT **), const char *s, const CharT *input) {
+    bool ok = true;
+    for (int with_end = 0; with_end < 2; ++with_end) {
+        T out, ref_out;
+        memset(&out, 0xa5, sizeof(T));
+        memset(&ref_out, 0xa5, sizeof(T));
+        CharT *end = sentinel<CharT>(), *ref_end = sentinel<CharT>();
+        errno = errno_sentinel;
+        str2num_errno err = fn(&out, input, with_end ? &end : nullptr);
+        int error = errno;
+        errno = errno_sentinel;
+        str2num_errno ref_err = ref(&ref_out, input, with_end ? &ref_end : nullptr);
+        int ref_error = errno;
+        ok &= compare(name, s, input, 10, with_end, err, out, end, error, ref_err, ref_out, ref_end, ref_error);
+    }
+    return ok;
+}
+
+template <typename T>
+static std::string format_optional(const std::optional<T> &value, size_t pos, int error) {
+    std::string errno_text = " errno=" + std::to_string(error);
+    if (!value.has_value()) return "nullopt" + errno_text;
+    return hex_bits(*value) + " pos=" + (pos == (size_t)-1 ? std::string("untouched") : std::to_string(pos)) +
+           errno_text;
+}
+
+/*
+ * Run a safe_sto* wrapper and its reference, fn and ref take the pos pointer.
+ */
+template <typename Fn, typename RefFn>
+static bool check_safe(const char *name, const char *s, int base, Fn fn, RefFn ref) {
+    ++checks;
+    size_t pos = (size_t)-1, ref_pos = (size_t)-1;
+    errno = errno_sentinel;
+    auto value = fn(&pos);
+    int error = errno;
+    errno = errno_sentinel;
+    auto ref_value = ref(&ref_pos);
+    int ref_error = errno;
+    if (value.has_value() == ref_value.has_value() && error == ref_error &&
+        (!value.has_value() || (memcmp(&*value, &*ref_value, sizeof(*value)) == 0 && pos == ref_pos)))
+        return true;
+    report(name, s, base, "std::string", format_optional(value, pos, error),
+           format_optional(ref_value, ref_pos, ref_error));
+    return false;
+}
+
+/*
+ * Check every integer conversion on s in the given base. An invalid base is
+ * only checked without endptr.
+ */
+static bool check_integers(const char *s, int base) {
+    bool ok = true;
+    ok &= check_integer<int, char>("str2int", str2int, s2n_ref::str2int, s, s, base);
+    ok &= check_integer<unsigned int, char>("str2uint", str2uint, s2n_ref::str2uint, s, s, base);
+    ok &= check_integer<long, char>("str2l", str2l, s2n_ref::str2l, s, s, base);
+    ok &= check_integer<unsigned long, char>("str2ul", str2ul, s2n_ref::str2ul, s, s, base);
+    ok &= check_integer<long long, char>("str2ll", str2ll, s2n_ref::str2ll, s, s, base);
+    ok &= check_integer<unsigned long long, char>("str2ull", str2ull, s2n_ref::str2ull, s, s, base);
+    if (s == nullptr) return ok;
+
+    std::wstring wide = widen(s);
+    const wchar_t *w = wide.c_str();
+    ok &= check_integer<int, wchar_t>("str2int", str2int, s2n_ref::str2int, s, w, base);
+    ok &= check_integer<unsigned int, wchar_t>("str2uint", str2uint, s2n_ref::str2uint, s, w, base);
+    ok &= check_integer<long, wchar_t>("str2l", str2l, s2n_ref::str2l, s, w, base);
+    ok &= check_integer<unsigned long, wchar_t>("str2ul", str2ul, s2n_ref::str2ul, s, w, base);
+    ok &= check_integer<long long, wchar_t>("str2ll", str2ll, s2n_ref::str2ll, s, w, base);
+    ok &= check_integer<unsigned long long, wchar_t>("str2ull", str2ull, s2n_ref::str2ull, s, w, base);
+
+    /* The wrappers always pass an endptr, see valid_base. */
+    if (!valid_base(base)) return ok;
+    std::string str = s;
+    ok &= check_safe("safe_stoi", s, base, [&](size_t *pos) { return s2n::safe_stoi(str, pos, base); },
+                     [&](size_t *pos) { return s2n_ref::safe_stoi(str, pos, base); });
+    ok &= check_safe("safe_stol", s, base, [&](size_t *pos) { return s2n::safe_stol(str, pos, base); },
+                     [&](size_t *pos) { return s2n_ref::safe_stol(str, pos, base); });
+    ok &= check_safe("safe_stoul", s, base, [&](size_t *pos) { return s2n::safe_stoul(str, pos, base); },
+                     [&](size_t *pos) { return s2n_ref::safe_stoul(str, pos, base); });
+    ok &= check_safe("safe_stoll", s, base, [&](size_t *pos) { return s2n::safe_stoll(str, pos, base); },
+                     [&](size_t *pos) { return s2n_ref::safe_stoll(str, pos, base); });
+    ok &= check_safe("safe_stoull", s, base, [&](size_t *pos) { return s2n::safe_stoull(str, pos, base); },
+                     [&](size_t *pos) { return s2n_ref::safe_stoull(str, pos, base); });
+    return ok;
+}
+
+/*
+ * Check both floating point conversions on s.
+ */
+static bool check_floatings(const char *s) {
+    bool ok = true;
+    ok &= check_floating<double, char>("str2d", str2d, s2n_ref::str2d, s, s);
+    ok &= check_floating<float, char>("str2f", str2f, s2n_ref::str2f, s, s);
+    if (s == nullptr) return ok;
+
+    std::wstring wide = widen(s);
+    ok &= check_floating<double, wchar_t>("str2d", str2d, s2n_ref::str2d, s, wide.c_str());
+    ok &= check_floating<float, wchar_t>("str2f", str2f, s2n_ref::str2f, s, wide.c_str());
+
+    std::string str = s;
+    ok &= check_safe("safe_stod", s, 10, [&](size_t *pos) { return s2n::safe_stod(str, pos); },
+                     [&](size_t *pos) { return s2n_ref::safe_stod(str, pos); });
+    ok &= check_safe("safe_stof", s, 10, [&](size_t *pos) { return s2n::safe_stof(str, pos); },
+                     [&](size_t *pos) { return s2n_ref::safe_stof(str, pos); });
+    return ok;
+}
+};  // namespace s2n_diff
+#endif
@@ -0,0 +1,71 @@
+//  SPDX-FileCopyrightText: 2022 Kish Jadhav
+//  SPDX-License-Identifier: MIT License
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <string>
+
+#include "differential.hpp"
+
+/*
+ * Fuzz target comparing str2num.h with the libc reference.
+ *
+ * The first byte of the input selects the base, 0 or 2..36, the rest is the
+ * string handed to every conversion, as char and widened to wchar_t, and to
+ * the s2n::safe_sto* wrappers. Any difference aborts.
+ *
+ * Built with -DSTR2NUM_BUILD_FUZZER=ON (clang) this is a libFuzzer target.
+ * Otherwise STR2NUM_STANDALONE_FUZZER provides a main that replays the files
+ * given on the command line, or random inputs when there are none.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size == 0) return 0;
+    /*
+     * Only valid bases: with an invalid one strtol leaves endptr indeterminate
+     * and under ASan it really is garbage. The differential test covers
+     * invalid bases without endptr.
+     */
+    int base = data[0] % 36;
+    if (base != 0) ++base;
+    std::string s(reinterpret_cast<const char *>(data) + 1, size - 1);
+    bool ok = s2n_diff::check_integers(s.c_str(), base);
+    ok &= s2n_diff::check_floatings(s.c_str());
+    if (!ok) abort();
+    return 0;
+}
+
+#ifdef STR2NUM_STANDALONE_FUZZER
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            std::ifstream file(argv[i], std::ios::binary);
+            std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            std::cout << "Replaying " << argv[i] << "\n";
+            LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+        }
+        return 0;
+    }
+    // Printable bytes that matter to strtol/strtod are far more likely than
+    // the rest, so that random inputs actually reach the conversion logic.
+    static const char alphabet[] = "0123456789+-.eExXpPabcdefABCDEFinfINFnanNAN \t";
+    std::mt19937_64 rng(2022);
+    uint8_t buf[48];
+    for (int i = 0; i < 200000; ++i) {
+        size_t size = 1 + rng() % sizeof(buf);
+        buf[0] = (uint8_t)rng();
+        for (size_t j = 1; j < size; ++j) {
+            buf[j] = (rng() % 8 == 0) ? (uint8_t)rng() : (uint8_t)alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+        LLVMFuzzerTestOneInput(buf, size);
+    }
+    std::cout << s2n_diff::checks << " checks, " << s2n_diff::mismatches << " mismatches\n";
+    return 0;
+}
+#endif
@@ -0,0 +1,251 @@
+//  SPDX-FileCopyrightText: 2022 Kish Jadhav
+//  SPDX-License-Identifier: MIT License
+#ifndef REFERENCE_STR2NUM_HPP
+#define REFERENCE_STR2NUM_HPP
+#include "str2num.h"
+
+#include <optional>
+#include <string>
+
+/*
+ * Frozen copy of the libc backed str2* conversions.
+ *
+ * These are the behaviours every faster engine in str2num.h has to reproduce
+ * bit for bit: the returned str2num_errno, the value written to out and the
+ * position stored in endptr, for char and wchar_t input and for the
+ * s2n::safe_sto* wrappers. Do not "fix" anything in here, a difference
+ * between this file and str2num.h is exactly what the differential tests and
+ * the fuzzer are looking for.
+ */
+namespace s2n_ref {
+str2num_errno str2int(int *out, const char *s, char **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    long l = strtol(s, endptr, base);
+    if (l > INT_MAX || (errno == ERANGE && l == LONG_MAX)) return STR2NUM_OVERFLOW;
+    if (l < INT_MIN || (errno == ERANGE && l == LONG_MIN)) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2uint(unsigned int *out, const char *s, char **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    unsigned long int l = strtoul(s, endptr, base);
+    if (errno == ERANGE && l == ULONG_MAX) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && l == 0) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2l(long *out, const char *s, char **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    long l = strtol(s, endptr, base);
+    if (errno == ERANGE && l == LONG_MAX) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && l == LONG_MIN) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2ul(unsigned long *out, const char *s, char **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    long l = strtoul(s, endptr, base);
+    if (errno == ERANGE && l == LONG_MAX) return STR2NUM_OVERFLOW;
+    if ((errno == ERANGE) || (endptr != nullptr && **endptr != '\0')) return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2ll(long long int *out, const char *s, char **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    long long int l = strtoll(s, endptr, base);
+    if (errno == ERANGE && l == LLONG_MAX) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && l == LLONG_MIN) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2ull(long long unsigned int *out, const char *s, char **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    long long unsigned int l = strtoull(s, endptr, base);
+    if (errno == ERANGE && l == ULLONG_MAX) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && l == 0) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2d(double *out, const char *s, char **endptr) {
+    if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
+    char *ptr = NULL;
+    errno = 0;
+    double result = strtod(s, &ptr);
+    if (errno == ERANGE && result >= HUGE_VAL) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && result <= -HUGE_VAL) return STR2NUM_UNDERFLOW;
+    if (ptr != nullptr && s == ptr) return STR2NUM_INCONVERTIBLE;
+    *out = result;
+    if (endptr != NULL) (*endptr = ptr);
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2f(float *out, const char *s, char **endptr) {
+    if (s == nullptr || s[0] == '\0' || isspace((unsigned char)s[0])) return STR2NUM_INCONVERTIBLE;
+    char *ptr = NULL;
+    errno = 0;
+    float result = strtof(s, &ptr);
+    if (errno == ERANGE && result >= HUGE_VALF) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && result <= -HUGE_VALF) return STR2NUM_UNDERFLOW;
+    if (ptr != nullptr && s == ptr) return STR2NUM_INCONVERTIBLE;
+    *out = result;
+    if (endptr != NULL) (*endptr = ptr);
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2int(int *out, const wchar_t *s, wchar_t **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || iswspace(s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    long l = wcstol(s, endptr, base);
+    if (l > INT_MAX || (errno == ERANGE && l == LONG_MAX)) return STR2NUM_OVERFLOW;
+    if (l < INT_MIN || (errno == ERANGE && l == LONG_MIN)) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2uint(unsigned int *out, const wchar_t *s, wchar_t **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || iswspace(s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    unsigned long int l = wcstoul(s, endptr, base);
+    if (errno == ERANGE && l == ULONG_MAX) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && l == 0) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2l(long *out, const wchar_t *s, wchar_t **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || iswspace(s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    long l = wcstol(s, endptr, base);
+    if (errno == ERANGE && l == LONG_MAX) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && l == LONG_MIN) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2ul(unsigned long *out, const wchar_t *s, wchar_t **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || iswspace(s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    unsigned long l = wcstoul(s, endptr, base);
+    if (errno == ERANGE && l == ULONG_MAX) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && l == 0) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2ll(long long int *out, const wchar_t *s, wchar_t **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || iswspace(s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    long long int l = wcstoll(s, endptr, base);
+    if (errno == ERANGE && l == LLONG_MAX) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && l == LLONG_MIN) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2ull(long long unsigned int *out, const wchar_t *s, wchar_t **endptr, int base) {
+    if (s == nullptr || s[0] == '\0' || iswspace(s[0])) return STR2NUM_INCONVERTIBLE;
+    errno = 0;
+    long long unsigned int l = wcstoull(s, endptr, base);
+    if (errno == ERANGE && l == ULLONG_MAX) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && l == 0) return STR2NUM_UNDERFLOW;
+    if (endptr != nullptr && **endptr != '\0') return STR2NUM_INCONVERTIBLE;
+    *out = l;
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2d(double *out, const wchar_t *s, wchar_t **endptr) {
+    if (s == nullptr || s[0] == '\0' || iswspace(s[0])) return STR2NUM_INCONVERTIBLE;
+    wchar_t *ptr = NULL;
+    errno = 0;
+    double result = wcstod(s, &ptr);
+    if (errno == ERANGE && result >= HUGE_VAL) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && result <= -HUGE_VAL) return STR2NUM_UNDERFLOW;
+    if (ptr != nullptr && s == ptr) return STR2NUM_INCONVERTIBLE;
+    *out = result;
+    if (endptr != NULL) (*endptr = ptr);
+    return STR2NUM_SUCCESS;
+}
+
+str2num_errno str2f(float *out, const wchar_t *s, wchar_t **endptr) {
+    if (s == nullptr || s[0] == '\0' || iswspace(s[0])) return STR2NUM_INCONVERTIBLE;
+    wchar_t *ptr = NULL;
+    errno = 0;
+    float result = wcstof(s, &ptr);
+    if (errno == ERANGE && result >= HUGE_VALF) return STR2NUM_OVERFLOW;
+    if (errno == ERANGE && result <= -HUGE_VALF) return STR2NUM_UNDERFLOW;
+    if (ptr != nullptr && s == ptr) return STR2NUM_INCONVERTIBLE;
+    *out = result;
+    if (endptr != NULL) (*endptr = ptr);
+    return STR2NUM_SUCCESS;
+}
+/*
+ * The s2n::safe_sto* wrappers. Only the std::string instantiations build, the
+ * std::wstring ones pass a char ** endptr to the wide overloads.
+ */
+template <typename R, typename T>
+std::optional<R> safe_sto(str2num_errno (*fn)(T *, const char *, char **, int), const std::string &str,
+                          std::size_t *pos, int base) {
+    T out;
+    char *endptr = nullptr;
+    if (fn(&out, str.c_str(), &endptr, base) == STR2NUM_SUCCESS) {
+        if (pos != nullptr) *pos = endptr - str.c_str();
+        return out;
+    } else
+        return std::nullopt;
+}
+std::optional<int> safe_stoi(const std::string &str, std::size_t *pos, int base) {
+    return safe_sto<int, int>(str2int, str, pos, base);
+}
+std::optional<long> safe_stol(const std::string &str, std::size_t *pos, int base) {
+    return safe_sto<long, long>(str2l, str, pos, base);
+}
+std::optional<unsigned long> safe_stoul(const std::string &str, std::size_t *pos, int base) {
+    return safe_sto<unsigned long, unsigned long>(str2ul, str, pos, base);
+}
+std::optional<long long> safe_stoll(const std::string &str, std::size_t *pos, int base) {
+    return safe_sto<long long, long long>(str2ll, str, pos, base);
+}
+std::optional<unsigned long long> safe_stoull(const std::string &str, std::size_t *pos, int base) {
+    return safe_sto<unsigned long long, unsigned long long>(str2ull, str, pos, base);
+}
+std::optional<double> safe_stod(const std::string &str, std::size_t *pos) {
+    double out;
+    char *endptr = nullptr;
+    if (str2d(&out, str.c_str(), &endptr) == STR2NUM_SUCCESS) {
+        if (pos != nullptr) *pos = endptr - str.c_str();
+        return out;
+    } else
+        return std::nullopt;
+}
+std::optional<float> safe_stof(const std::string &str, std::size_t *pos) {
+    float out;
+    if (str2f(&out, str.c_str(), NULL) == STR2NUM_SUCCESS) {
+        if (pos != nullptr) *pos = str.size();
+        return out;
+    } else
+        return std::nullopt;
+}
+};  // namespace s2n_ref
+#endif
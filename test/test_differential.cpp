@@ -0,0 +1,158 @@
+//  SPDX-FileCopyrightText: 2022 Kish Jadhav
+//  SPDX-License-Identifier: MIT License
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "differential.hpp"
+
+/*
+ * Differential test of str2num.h against the libc reference.
+ *
+ * Usage: str2num_differential [--exhaustive] [--seed=N] [--iterations=N]
+ *
+ *   --exhaustive   walk all 2^32 float32 bit patterns instead of a sample.
+ *   --seed         seed of the random integer and string inputs.
+ *   --iterations   number of random inputs per test.
+ */
+static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+static std::string to_base(unsigned long long value, int base, bool upper) {
+    if (value == 0) return "0";
+    std::string out;
+    while (value != 0) {
+        char c = digits[value % base];
+        out.insert(out.begin(), upper ? (char)toupper((unsigned char)c) : c);
+        value /= base;
+    }
+    return out;
+}
+
+static void testIntegerBoundaries() {
+    std::cout << "Testing integer boundaries in all bases\n";
+    const unsigned long long magnitudes[] = {
+        0ULL, 1ULL, INT_MAX, (unsigned long long)INT_MAX + 1, UINT_MAX, (unsigned long long)UINT_MAX + 1,
+        LONG_MAX, (unsigned long long)LONG_MAX + 1, ULONG_MAX, LLONG_MAX, (unsigned long long)LLONG_MAX + 1,
+        ULLONG_MAX, 999999999999999999ULL, 1000000000000000000ULL};
+    const char *signs[] = {"", "+", "-"};
+    for (int base = 2; base <= 36; ++base) {
+        for (unsigned long long magnitude : magnitudes) {
+            for (unsigned long long m : {magnitude - 1, magnitude, magnitude + 1}) {
+                for (const char *sign : signs) {
+                    std::string s = sign + to_base(m, base, false);
+                    s2n_diff::check_integers(s.c_str(), base);
+                    if (base == 10) s2n_diff::check_integers(s.c_str(), 0);
+                    if (base == 16) {
+                        s2n_diff::check_integers((sign + std::string("0x") + to_base(m, 16, true)).c_str(), 0);
+                    }
+                    if (base == 8) {
+                        s2n_diff::check_integers((sign + std::string("0") + to_base(m, 8, false)).c_str(), 0);
+                    }
+                }
+            }
+        }
+    }
+    const char *literals[] = {"",    " 1",   "\t1", "1 ",  "+",  "-",   "+-1", "0x",   "0X",     "0x1g",
+                              "00",  "-0",   "08",  "0b1", "1e3", "12a", "a12", "1.5", "0xffz", "18446744073709551616",
+                              "-9223372036854775809", "99999999999999999999999999999", "0000000000000000000000000001",
+                              "-00000000000000000000009223372036854775808", "18446744073709551615x"};
+    for (const char *s : literals) {
+        for (int base : {0, 2, 8, 10, 16, 36}) s2n_diff::check_integers(s, base);
+        // strtol leaves endptr indeterminate for an invalid base, so these
+        // only run without endptr (see s2n_diff::valid_base).
+        for (int base : {-1, 1, 37}) s2n_diff::check_integers(s, base);
+    }
+    s2n_diff::check_integers(nullptr, 10);
+    std::cout << "Test complete\n\n";
+}
+
+static void testRandomIntegers(std::mt19937_64 &rng, unsigned long long iterations) {
+    std::cout << "Testing random 64-bit integers in all bases\n";
+    const char *suffixes[] = {"", "", "", " ", "x", ".", "9", "z", "\n"};
+    for (unsigned long long i = 0; i < iterations; ++i) {
+        unsigned long long value = rng();
+        // Bias towards short numbers as well, they are the common case.
+        value >>= rng() % 64;
+        int base = 2 + rng() % 35;
+        std::string sign = (rng() % 3 == 0) ? "-" : ((rng() % 5 == 0) ? "+" : "");
+        const char *suffix = suffixes[rng() % (sizeof(suffixes) / sizeof(suffixes[0]))];
+        std::string s = sign + to_base(value, base, rng() % 2) + suffix;
+        s2n_diff::check_integers(s.c_str(), base);
+        if (base == 10) s2n_diff::check_integers(s.c_str(), 0);
+        if (base == 16) s2n_diff::check_integers((sign + "0x" + to_base(value, 16, false) + suffix).c_str(), 0);
+    }
+    std::cout << "Test complete\n\n";
+}
+
+static void testRandomStrings(std::mt19937_64 &rng, unsigned long long iterations) {
+    std::cout << "Testing random strings\n";
+    static const char alphabet[] = "0123456789012345678901234567890123456789abcdefzABCDEFZxXpPeE+-.infINFnaNA \t\n";
+    for (unsigned long long i = 0; i < iterations; ++i) {
+        std::string s;
+        size_t length = rng() % 33;
+        for (size_t j = 0; j < length; ++j) s += alphabet[rng() % (sizeof(alphabet) - 1)];
+        int base = (int)(rng() % 36);
+        s2n_diff::check_integers(s.c_str(), base == 0 ? 0 : base + 1);
+        s2n_diff::check_floatings(s.c_str());
+    }
+    std::cout << "Test complete\n\n";
+}
+
+static void testFloatingPatterns(std::mt19937_64 &rng, unsigned long long iterations, bool exhaustive) {
+    std::cout << "Testing float32 bit patterns" << (exhaustive ? " (exhaustive)\n" : " (sampled)\n");
+    // 16381 is prime, so the sample hits every exponent and a spread of mantissas.
+    const unsigned long long stride = exhaustive ? 1 : 16381;
+    char buf[64];
+    for (unsigned long long bits = 0; bits <= 0xffffffffULL; bits += stride) {
+        uint32_t pattern = (uint32_t)bits;
+        float f;
+        memcpy(&f, &pattern, sizeof(f));
+        snprintf(buf, sizeof(buf), "%.9g", f);
+        s2n_diff::check_floatings(buf);
+        snprintf(buf, sizeof(buf), "%.17g", (double)f);
+        s2n_diff::check_floatings(buf);
+        snprintf(buf, sizeof(buf), "%a", f);
+        s2n_diff::check_floatings(buf);
+    }
+    std::cout << "Testing random float64 bit patterns\n";
+    for (unsigned long long i = 0; i < iterations; ++i) {
+        uint64_t pattern = rng();
+        double d;
+        memcpy(&d, &pattern, sizeof(d));
+        snprintf(buf, sizeof(buf), "%.17g", d);
+        s2n_diff::check_floatings(buf);
+        snprintf(buf, sizeof(buf), "%.*e", (int)(rng() % 20), d);
+        s2n_diff::check_floatings(buf);
+    }
+    std::cout << "Test complete\n\n";
+}
+
+int main(int argc, char **argv) {
+    bool exhaustive = false;
+    unsigned long long seed = 2022;
+    unsigned long long iterations = 100000;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--exhaustive") == 0) {
+            exhaustive = true;
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            seed = strtoull(argv[i] + 7, nullptr, 10);
+        } else if (strncmp(argv[i], "--iterations=", 13) == 0) {
+            iterations = strtoull(argv[i] + 13, nullptr, 10);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--exhaustive] [--seed=N] [--iterations=N]\n";
+            return 2;
+        }
+    }
+    std::mt19937_64 rng(seed);
+    std::cout << "Differential test, seed " << seed << "\n\n";
+    testIntegerBoundaries();
+    testRandomIntegers(rng, iterations);
+    testRandomStrings(rng, iterations);
+    testFloatingPatterns(rng, iterations, exhaustive);
+    std::cout << s2n_diff::checks << " checks, " << s2n_diff::mismatches << " mismatches\n";
+    return s2n_diff::mismatches == 0 ? 0 : 1;
+}
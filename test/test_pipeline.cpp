@@ -0,0 +1,212 @@
+//  SPDX-FileCopyrightText: 2022 Kish Jadhav
+//  SPDX-License-Identifier: MIT License
+#include "str2num_pipeline.h"
+#include <iostream>
+#include <assert.h>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestParseColumn{
+    public:
+    TestParseColumn(){
+        std::cout << "Testing column conversion\n";
+        test_conversion();
+        test_errors();
+        test_delimiter();
+        std::cout << "Test complete\n\n";
+    }
+    private:
+    void test_conversion(){
+        auto result = s2n::parse_column<long long>("1\n-20\n300\n");
+        assert(result.invalid == 0);
+        assert((result.values == std::vector<long long>{1, -20, 300}));
+        auto doubles = s2n::parse_column<double>("1.5\n-2e3");
+        assert((doubles.values == std::vector<double>{1.5, -2e3}));
+        assert(s2n::parse_column<int>("").values.empty());
+    }
+    void test_errors(){
+        auto result = s2n::parse_column<int>("1\n\n99999999999\n4x\n5");
+        assert((result.values == std::vector<int>{1, 0, 0, 0, 5}));
+        assert((result.errors == std::vector<str2num_errno>{STR2NUM_SUCCESS, STR2NUM_INCONVERTIBLE, STR2NUM_OVERFLOW,
+                                                            STR2NUM_INCONVERTIBLE, STR2NUM_SUCCESS}));
+        assert(result.invalid == 3);
+        auto doubles = s2n::parse_column<double>("1.5x\n2");
+        assert(doubles.errors[0] == STR2NUM_INCONVERTIBLE && doubles.values[1] == 2);
+    }
+    void test_delimiter(){
+        auto result = s2n::parse_column<unsigned long long>("7,8,9", ',');
+        assert((result.values == std::vector<unsigned long long>{7, 8, 9}));
+    }
+};
+
+class TestBoundedQueue{
+    public:
+    TestBoundedQueue(){
+        std::cout << "Testing bounded queue\n";
+        test_capacity();
+        test_concurrent();
+        std::cout << "Test complete\n\n";
+    }
+    private:
+    void test_capacity(){
+        s2n::bounded_queue<int> queue(5);
+        assert(queue.capacity() == 8);
+        for(int i = 0; i < 8; ++i) assert(queue.try_push(i));
+        int value = 100;
+        assert(!queue.try_push(value) && value == 100);
+        for(int i = 0; i < 8; ++i) assert(queue.try_pop(value) && value == i);
+        assert(!queue.try_pop(value));
+    }
+    void test_concurrent(){
+        const int producers = 4, per_producer = 100000;
+        s2n::bounded_queue<int> queue(16);
+        std::atomic<long long> sum{0};
+        std::atomic<int> popped{0};
+        std::vector<std::thread> threads;
+        for(int p = 0; p < producers; ++p){
+            threads.emplace_back([&queue]{
+                for(int i = 1; i <= per_producer; ++i){
+                    int value = i;
+                    while(!queue.try_push(value)) std::this_thread::yield();
+                }
+            });
+            threads.emplace_back([&]{
+                int value;
+                while(popped.load() < producers * per_producer){
+                    if(queue.try_pop(value)){
+                        sum += value;
+                        ++popped;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for(auto &t : threads) t.join();
+        assert(sum == (long long)producers * per_producer * (per_producer + 1) / 2);
+    }
+};
+
+class TestPipeline{
+    public:
+    TestPipeline(){
+        std::cout << "Testing conversion pipeline\n";
+        test_in_order();
+        test_backpressure();
+        test_multiple_producers();
+        test_in_flight_window();
+        std::cout << "Test complete\n\n";
+    }
+    private:
+    static std::string make_buffer(int chunk, int count){
+        std::string buffer;
+        for(int i = 0; i < count; ++i) buffer += std::to_string((long long)chunk * count + i) + "\n";
+        return buffer;
+    }
+    static void check_chunk(const s2n::column<long long> &chunk, int index, int count){
+        assert(chunk.invalid == 0 && (int)chunk.values.size() == count);
+        for(int i = 0; i < count; ++i) assert(chunk.values[i] == (long long)index * count + i);
+    }
+    static void print_stats(const s2n::pipeline_stats &stats){
+        std::cout << "   " << stats.completed << " chunks, " << stats.values << " values, "
+                  << (long long)stats.values_per_second << " values/s, "
+                  << (long long)(stats.bytes_per_second / 1e6) << " MB/s, max queue depth "
+                  << stats.max_queue_depth << "\n";
+    }
+    void test_in_order(){
+        // An in-memory producer standing in for a spool reader.
+        const int chunks = 200, count = 1000;
+        std::vector<std::uint64_t> delivered;
+        s2n::pipeline_options options;
+        options.workers = 4;
+        options.queue_capacity = 8;
+        auto on_chunk = [&delivered](std::uint64_t sequence, const s2n::column<long long> &chunk){
+            delivered.push_back(sequence);
+            assert(chunk.values.size() == count);
+        };
+        s2n::conversion_pipeline<long long> pipeline(options, on_chunk);
+        assert(pipeline.workers() == 4);
+        std::deque<std::future<s2n::column<long long>>> futures;
+        for(int c = 0; c < chunks; ++c) futures.push_back(pipeline.submit(make_buffer(c, count)));
+        for(int c = 0; c < chunks; ++c){
+            check_chunk(futures.front().get(), c, count);
+            futures.pop_front();
+        }
+        for(int c = 0; c < chunks; ++c) assert(delivered[c] == (std::uint64_t)c);
+        s2n::pipeline_stats stats = pipeline.stats();
+        assert(stats.submitted == chunks && stats.completed == chunks);
+        assert(stats.values == (std::uint64_t)chunks * count && stats.invalid == 0);
+        assert(stats.queue_depth == 0);
+        assert(stats.max_queue_depth >= 1 && stats.max_queue_depth <= pipeline.queue_capacity());
+        print_stats(stats);
+    }
+    void test_backpressure(){
+        // A single slow consumer: submit has to wait for the queue to drain.
+        s2n::pipeline_options options;
+        options.workers = 1;
+        options.queue_capacity = 2;
+        s2n::conversion_pipeline<int> pipeline(options, [](std::uint64_t, const s2n::column<int> &){
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+        std::vector<std::future<s2n::column<int>>> futures;
+        for(int c = 0; c < 50; ++c) futures.push_back(pipeline.submit(std::to_string(c)));
+        for(int c = 0; c < 50; ++c) assert(futures[c].get().values[0] == c);
+        assert(pipeline.queue_capacity() == 2 && pipeline.stats().max_queue_depth <= pipeline.queue_capacity());
+    }
+    void test_multiple_producers(){
+        const int producers = 4, chunks = 100, count = 100;
+        std::uint64_t last = 0;
+        bool ordered = true;
+        s2n::pipeline_options options;
+        options.queue_capacity = 4;
+        auto on_chunk = [&](std::uint64_t sequence, const s2n::column<long long> &){
+            ordered &= (sequence == 0 || sequence == last + 1);
+            last = sequence;
+        };
+        s2n::conversion_pipeline<long long> pipeline(options, on_chunk);
+        std::vector<std::thread> threads;
+        for(int p = 0; p < producers; ++p){
+            threads.emplace_back([&pipeline, p]{
+                std::vector<std::future<s2n::column<long long>>> futures;
+                for(int c = 0; c < chunks; ++c) futures.push_back(pipeline.submit(make_buffer(p * chunks + c, count)));
+                for(int c = 0; c < chunks; ++c) check_chunk(futures[c].get(), p * chunks + c, count);
+            });
+        }
+        for(auto &t : threads) t.join();
+        assert(ordered && last == producers * chunks - 1);
+        s2n::pipeline_stats stats = pipeline.stats();
+        assert(stats.max_queue_depth >= 1 && stats.max_queue_depth <= pipeline.queue_capacity());
+        assert(stats.queue_depth == 0 && stats.in_flight == 0);
+        print_stats(stats);
+    }
+    void test_in_flight_window(){
+        // A slow consumer must hold the producer back, not pile up parsed chunks.
+        s2n::pipeline_options options;
+        options.workers = 4;
+        options.queue_capacity = 8;
+        options.max_in_flight = 3;
+        std::atomic<std::size_t> max_in_flight{0};
+        s2n::conversion_pipeline<int> *self = nullptr;
+        s2n::conversion_pipeline<int> pipeline(options, [&](std::uint64_t, const s2n::column<int> &){
+            std::size_t in_flight = self->stats().in_flight;
+            if(in_flight > max_in_flight) max_in_flight = in_flight;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+        self = &pipeline;
+        assert(pipeline.max_in_flight() == 3);
+        std::vector<std::future<s2n::column<int>>> futures;
+        for(int c = 0; c < 50; ++c) futures.push_back(pipeline.submit(std::to_string(c)));
+        for(int c = 0; c < 50; ++c) assert(futures[c].get().values[0] == c);
+        assert(max_in_flight >= 1 && max_in_flight <= 3);
+        assert(pipeline.stats().in_flight == 0);
+    }
+};
+
+int main(){
+    TestParseColumn();
+    TestBoundedQueue();
+    TestPipeline();
+    return 0;
+}
@@ -0,0 +1,56 @@
+//  SPDX-FileCopyrightText: 2022 Kish Jadhav
+//  SPDX-License-Identifier: MIT License
+#include "str2num.h"
+#include <iostream>
+#include <assert.h>
+
+using s2n::detail::tables;
+using s2n::detail::tables_t;
+
+class TestTables{
+    public:
+    TestTables(){
+        std::cout << "Testing shared lookup tables\n";
+        test_layout();
+        test_digits();
+        test_powers_of_ten();
+        test_cutoffs();
+        test_powers_of_five();
+        std::cout << "Test complete\n\n";
+    }
+    private:
+    void test_layout(){
+        assert(reinterpret_cast<uintptr_t>(&tables) % 64 == 0);
+    }
+    void test_digits(){
+        assert(tables.digit_value['0'] == 0 && tables.digit_value['9'] == 9);
+        assert(tables.digit_value['a'] == 10 && tables.digit_value['Z'] == 35);
+        assert(tables.digit_value['/'] == 0xff && tables.digit_value[':'] == 0xff);
+        assert(tables.digit_value[0] == 0xff && tables.digit_value[0xb0] == 0xff);
+    }
+    void test_powers_of_ten(){
+        assert(tables.pow10_u64[19] == 10000000000000000000ULL);
+        for(int i = 0; i < 23; ++i) assert(tables.pow10_f64[i] == strtod(("1e" + std::to_string(i)).c_str(), nullptr));
+    }
+    void test_cutoffs(){
+        assert(tables.cutoff_u64[10] == 1844674407370955161ULL && tables.cutlim_u64[10] == 5);
+        assert(tables.cutoff_u64[16] == 0x0fffffffffffffffULL && tables.cutlim_u64[16] == 15);
+        assert(s2n::detail::int_limits<int>::max_negative == 2147483648ULL);
+        assert(s2n::detail::int_limits<unsigned int>::max_negative == 0);
+    }
+    void test_powers_of_five(){
+        // Reference values from the Eisel-Lemire tables in fast_float.
+        assert(tables.pow5(0).hi == 0x8000000000000000ULL && tables.pow5(0).lo == 0);
+        assert(tables.pow5(1).hi == 0xa000000000000000ULL && tables.pow5(1).lo == 0);
+        assert(tables.pow5(55).hi == 0xd0cf4b50cfe20765ULL && tables.pow5(55).lo == 0xfff4b4e3f741cf6dULL);
+        assert(tables.pow5(-1).hi == 0xccccccccccccccccULL && tables.pow5(-1).lo == 0xcccccccccccccccdULL);
+        assert(tables.pow5(-27).hi == 0x9e74d1b791e07e48ULL && tables.pow5(-27).lo == 0x775ea264cf55347eULL);
+        assert(tables.pow5(-2).hi == 0xa3d70a3d70a3d70aULL && tables.pow5(-2).lo == 0x3d70a3d70a3d70a4ULL);
+        for(int q = tables_t::pow5_min; q <= tables_t::pow5_max; ++q) assert(tables.pow5(q).hi >> 63);
+    }
+};
+
+int main(){
+    TestTables();
+    return 0;
+}